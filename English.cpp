@@ -3,29 +3,136 @@
 // For Seattle University, CPSC 5005, P5.Hashing-Hobbit.
 //
 
-#include <sstream>
+#include <cctype>
 #include "English.h"
 
 using namespace std;
 
-string English::cleanWord(string s) {
-    ostringstream result;
+string English::cleanWord(const string &s) {
+    string result;
     int length = s.length();
+    // The clean word is never longer than the dirty one
+    result.reserve(length);
     for (int i = 0; i < length; i++) {
         if (isalnum(s[i])) {
             // Keep all letters and digits
-            result << (char) tolower(s[i]);
+            result += (char) tolower(s[i]);
         } else if (s[i] == APOSTROPHE_CHAR) {
             // Keep embedded and trailing apostrophes
             if (i > 0 && isalnum(s[i - 1]))
-                result << (char) s[i];
+                result += s[i];
         } else if (s[i] == HYPHEN_CHAR) {
             // Keep embedded and trailing hyphens
             if (i > 0 && isalnum(s[i - 1]))
-                result << (char) s[i];
+                result += s[i];
         }
     }
-    return result.str();
+    return result;
+}
+
+string English::stem(const string &cleanedWord) {
+    string word = cleanedWord;
+    // Leave short words (and words with apostrophes or hyphens) alone
+    if (word.length() <= 2 ||
+        word.find_first_of(string(1, APOSTROPHE_CHAR) + HYPHEN_CHAR) !=
+        string::npos)
+        return word;
+
+    // Step 1a: plurals
+    if (endsWith(word, "sses") || endsWith(word, "ies"))
+        word.erase(word.length() - 2);
+    else if (!endsWith(word, "ss") && endsWith(word, "s"))
+        word.erase(word.length() - 1);
+
+    // Step 1b: past tenses and "-ing" forms
+    bool removedEnding = false;
+    if (endsWith(word, "eed")) {
+        if (measure(word, word.length() - 3) > 0)
+            word.erase(word.length() - 1);
+    } else if (endsWith(word, "ed") && hasVowel(word, word.length() - 2)) {
+        word.erase(word.length() - 2);
+        removedEnding = true;
+    } else if (endsWith(word, "ing") && hasVowel(word, word.length() - 3)) {
+        word.erase(word.length() - 3);
+        removedEnding = true;
+    }
+    if (removedEnding) {
+        int length = word.length();
+        if (endsWith(word, "at") || endsWith(word, "bl") ||
+            endsWith(word, "iz")) {
+            // e.g. "conflat(ed)" -> "conflate"
+            word += 'e';
+        } else if (endsWithDoubleConsonant(word, length) &&
+                   word[length - 1] != 'l' && word[length - 1] != 's' &&
+                   word[length - 1] != 'z') {
+            // e.g. "hopp(ing)" -> "hop"
+            word.erase(length - 1);
+        } else if (measure(word, length) == 1 && endsWithCvc(word, length)) {
+            // e.g. "hop(ing)" -> "hope"
+            word += 'e';
+        }
+    }
+
+    // Step 1c: final "y" after a vowel-containing stem
+    if (endsWith(word, "y") && hasVowel(word, word.length() - 1))
+        word[word.length() - 1] = 'i';
+    return word;
+}
+
+bool English::isConsonant(const string &word, int i) {
+    switch (word[i]) {
+        case 'a': case 'e': case 'i': case 'o': case 'u':
+            return false;
+        case 'y':
+            return i == 0 || !isConsonant(word, i - 1);
+        default:
+            return true;
+    }
+}
+
+int English::measure(const string &word, int length) {
+    int m = 0;
+    int i = 0;
+    // Skip the optional leading consonants
+    while (i < length && isConsonant(word, i))
+        i++;
+    while (i < length) {
+        // Count each run of vowels followed by a run of consonants
+        while (i < length && !isConsonant(word, i))
+            i++;
+        if (i == length)
+            break;
+        while (i < length && isConsonant(word, i))
+            i++;
+        m++;
+    }
+    return m;
+}
+
+bool English::hasVowel(const string &word, int length) {
+    for (int i = 0; i < length; i++)
+        if (!isConsonant(word, i))
+            return true;
+    return false;
+}
+
+bool English::endsWithDoubleConsonant(const string &word, int length) {
+    return length >= 2 && word[length - 1] == word[length - 2] &&
+           isConsonant(word, length - 1);
+}
+
+bool English::endsWithCvc(const string &word, int length) {
+    if (length < 3 || !isConsonant(word, length - 3) ||
+        isConsonant(word, length - 2) || !isConsonant(word, length - 1))
+        return false;
+    char last = word[length - 1];
+    return last != 'w' && last != 'x' && last != 'y';
+}
+
+bool English::endsWith(const string &word, const string &suffix) {
+    return word.length() >= suffix.length() &&
+           word.compare(word.length() - suffix.length(), suffix.length(),
+                        suffix) == 0;
 }
 
 vector<string> English::commonWords() {
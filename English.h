@@ -26,7 +26,18 @@ public:
      * @param dirtyWord to clean
      * @return          clean version of dirtyWord
      */
-    static std::string cleanWord(std::string dirtyWord);
+    static std::string cleanWord(const std::string &dirtyWord);
+
+    /**
+     * Reduce a clean word to its stem by stripping inflectional endings
+     * (steps 1a-1c of the Porter stemming algorithm), so that, for example,
+     * "runs", "running" and "run" all have the stem "run".
+     * Only plurals, past tenses, "-ing" forms and a final "y" are handled;
+     * derivational suffixes such as "-ness" or "-ational" are left intact.
+     * @param cleanedWord to stem (as returned by cleanWord)
+     * @return            stem of cleanedWord
+     */
+    static std::string stem(const std::string &cleanedWord);
 
     /**
      * Get a list of common English words.
@@ -40,5 +51,38 @@ private:
      */
     static const char APOSTROPHE_CHAR = '\'', HYPHEN_CHAR = '-';
 
+    /**
+     * whether the letter at index i of word is a consonant in the Porter
+     * sense ('y' is a consonant unless it follows a consonant)
+     */
+    static bool isConsonant(const std::string &word, int i);
+
+    /**
+     * number of vowel-consonant sequences in the first length letters of
+     * word (the Porter measure m)
+     */
+    static int measure(const std::string &word, int length);
+
+    /**
+     * whether the first length letters of word contain a vowel
+     */
+    static bool hasVowel(const std::string &word, int length);
+
+    /**
+     * whether the first length letters of word end in a double consonant
+     */
+    static bool endsWithDoubleConsonant(const std::string &word, int length);
+
+    /**
+     * whether the first length letters of word end in consonant-vowel-
+     * consonant, where the last consonant is not 'w', 'x' or 'y'
+     */
+    static bool endsWithCvc(const std::string &word, int length);
+
+    /**
+     * whether word ends with suffix
+     */
+    static bool endsWith(const std::string &word, const std::string &suffix);
+
 };
 
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <string>
+#include "WordHash.h"
+
+/**
+ * Returns whether or not n is a prime number. Used to pick the capacity of a
+ * FixedWordCounter at compile time.
+ *
+ * @param n Number to check
+ * @return  True if n is prime
+ *          False otherwise
+ */
+constexpr bool isPrimeCapacity(int n) {
+    if (n < 2) {
+        return false;
+    }
+    for (int divisor = 2; divisor * divisor <= n; divisor++) {
+        if (n % divisor == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the smallest prime capacity that holds maxWords words without the
+ * load factor exceeding 0.75.
+ *
+ * @param maxWords Maximum number of unique words
+ * @return         Prime capacity
+ */
+constexpr int getFixedCapacity(int maxWords) {
+    int capacity = maxWords * 4 / 3 + 1;
+    while (!isPrimeCapacity(capacity)) {
+        capacity++;
+    }
+    return capacity;
+}
+
+/**
+ * Hash table of words (std::string) offering a subset of WordCounter's
+ * interface (adding, removing and counting single words, plus statistics),
+ * for small tables whose maximum number of unique words (N) is known at
+ * compile time. The buckets and Node objects are stored inline in the object
+ * itself, so a FixedWordCounter can live on the stack and never allocates
+ * memory for its table (words short enough for std::string's small-string
+ * optimization don't allocate either). Nodes are linked by their index into
+ * the inline Node array rather than by pointer. The capacity is a prime
+ * number chosen at compile time, and the table never resizes.
+ *
+ * Unlike WordCounter, a FixedWordCounter can become full: once N unique
+ * words have been added, addWord does NOT add new words - it returns 0 and
+ * the word is dropped (words already in the table are still counted) until a
+ * word is removed. Callers must check the return value of addWord, or full(),
+ * if they can't guarantee that at most N unique words will be added.
+ *
+ * @param N Maximum number of unique words
+ */
+template <int N>
+class FixedWordCounter {
+public:
+    /**
+     * Default constructor - initializes an empty hash table.
+     */
+    FixedWordCounter();
+
+    /**
+     * Adds a word to the hash table, if the word does not already exist in
+     * the hash table. If it does exist, then the count associated with that
+     * word is incremented by 1. Returns the number of times the given word has
+     * appeared in the hash table.
+     *
+     * @param word Word to add to the hash table
+     * @return     Number of times the word has been added to the table, or 0
+     *             if the word is new and the table is full, in which case
+     *             the word was NOT added
+     */
+    int addWord(const std::string &word);
+
+    /**
+     * Removes the given word (the Node object associated with the word and all
+     * its data) from the hash table.
+     *
+     * @param word Word to remove
+     */
+    void removeWord(const std::string &word);
+
+    /**
+     * Returns the count of the given word in the hash table.
+     *
+     * @param word Word to get count of
+     * @return     Count of the given word, or 0 if the word doesn't exist in
+     *             the hash table
+     */
+    int getWordCount(const std::string &word) const;
+
+    /**
+     * Returns the current load factor of the hash table.
+     *
+     * @return Load factor
+     */
+    double getLoadFactor() const;
+
+    /**
+     * Returns the number of unique words added to the hash table.
+     *
+     * @return Count of unique words
+     */
+    int getUniqueWordCount() const;
+
+    /**
+     * Returns the total number of words added to the hash table, including
+     * duplicates.
+     *
+     * @return Count of total words added
+     */
+    int getTotalWordCount() const;
+
+    /**
+     * Returns whether or not hash table is empty.
+     *
+     * @return True if no elements are present in the hash table
+     *         False if an element is present in the hash table
+     */
+    bool empty() const;
+
+    /**
+     * Returns whether or not hash table is full, that is, holds N unique
+     * words, so that new words can't be added.
+     *
+     * @return True if no more unique words can be added
+     *         False otherwise
+     */
+    bool full() const;
+
+    /**
+     * Returns capacity of the hash table.
+     *
+     * @return Capacity
+     */
+    int getCapacity() const;
+
+private:
+    static_assert(N > 0, "FixedWordCounter must hold at least one word");
+
+    static const int NO_NODE = -1; // Index representing a null link
+    static constexpr int CAPACITY = getFixedCapacity(N); // Number of buckets
+
+    /*
+     * Node object represents a word that is added to the hash table
+     */
+    struct Node {
+        std::string word; // Word to add
+        unsigned int hash; // Hash of the word
+        int wordCount; // Number of times the given word has been added
+        int next; // Index of the next Node in the bucket (or free list)
+    };
+
+    int totalWordCount; // Total number of words added
+    int uniqueWordCount; // Number of unique words added
+    int freeNode; // Index of the first unused Node, or NO_NODE if all are
+                  // in use
+    int wordTable[CAPACITY]; // Hash table (array of head Node indices)
+    Node nodes[N]; // Storage for every Node in the hash table
+
+    /**
+     * Returns the index of the Node which contains the given word, or
+     * NO_NODE if the word does not exist in the hash table.
+     *
+     * @param word Word to look up in hash table
+     * @param hash Hash of the word
+     * @return     Index of the Node with the given word, or NO_NODE
+     */
+    int getWordNode(const std::string &word, unsigned int hash) const;
+};
+
+template <int N>
+constexpr int FixedWordCounter<N>::CAPACITY;
+
+template <int N>
+FixedWordCounter<N>::FixedWordCounter() {
+    totalWordCount = 0;
+    uniqueWordCount = 0;
+    for (int bucket = 0; bucket < CAPACITY; bucket++) {
+        wordTable[bucket] = NO_NODE;
+    }
+    // Chain every Node into the free list
+    for (int node = 0; node < N; node++) {
+        nodes[node].next = node + 1 < N ? node + 1 : NO_NODE;
+    }
+    freeNode = 0;
+}
+
+template <int N>
+int FixedWordCounter<N>::addWord(const std::string &word) {
+    unsigned int hash = hashWord(word);
+    int node = getWordNode(word, hash);
+
+    // If the word does not exist in the hash table
+    if (node == NO_NODE) {
+        // No room for another unique word
+        if (freeNode == NO_NODE) {
+            return 0;
+        }
+        int bucket = hash % CAPACITY;
+        // Take the first unused Node and put it at the head of the bucket
+        node = freeNode;
+        freeNode = nodes[node].next;
+        nodes[node].word = word;
+        nodes[node].hash = hash;
+        nodes[node].wordCount = 1;
+        nodes[node].next = wordTable[bucket];
+        wordTable[bucket] = node;
+        uniqueWordCount++;
+    } else {
+        nodes[node].wordCount++;
+    }
+    totalWordCount++;
+    return nodes[node].wordCount;
+}
+
+template <int N>
+void FixedWordCounter<N>::removeWord(const std::string &word) {
+    unsigned int hash = hashWord(word);
+    int bucket = hash % CAPACITY;
+    int prev = NO_NODE;
+    for (int node = wordTable[bucket]; node != NO_NODE;
+         node = nodes[node].next) {
+        // If the word is found
+        if (nodes[node].hash == hash && nodes[node].word == word) {
+            // Unlink the Node from its bucket
+            if (prev == NO_NODE) {
+                wordTable[bucket] = nodes[node].next;
+            } else {
+                nodes[prev].next = nodes[node].next;
+            }
+            totalWordCount -= nodes[node].wordCount;
+            uniqueWordCount--;
+            // Return the Node to the free list
+            nodes[node].next = freeNode;
+            freeNode = node;
+            return;
+        }
+        prev = node;
+    }
+}
+
+template <int N>
+int FixedWordCounter<N>::getWordCount(const std::string &word) const {
+    int node = getWordNode(word, hashWord(word));
+    // Return the word count or 0 if not in the word table
+    return node == NO_NODE ? 0 : nodes[node].wordCount;
+}
+
+template <int N>
+double FixedWordCounter<N>::getLoadFactor() const {
+    return (double) uniqueWordCount / CAPACITY;
+}
+
+template <int N>
+int FixedWordCounter<N>::getUniqueWordCount() const {
+    return uniqueWordCount;
+}
+
+template <int N>
+int FixedWordCounter<N>::getTotalWordCount() const {
+    return totalWordCount;
+}
+
+template <int N>
+bool FixedWordCounter<N>::empty() const {
+    return totalWordCount == 0;
+}
+
+template <int N>
+bool FixedWordCounter<N>::full() const {
+    return freeNode == NO_NODE;
+}
+
+template <int N>
+int FixedWordCounter<N>::getCapacity() const {
+    return CAPACITY;
+}
+
+template <int N>
+int FixedWordCounter<N>::getWordNode(const std::string &word,
+                                     unsigned int hash) const {
+    // Look through entire chain of Nodes at the hash index
+    for (int node = wordTable[hash % CAPACITY]; node != NO_NODE;
+         node = nodes[node].next) {
+        // If the given word is found
+        if (nodes[node].hash == hash && nodes[node].word == word) {
+            return node;
+        }
+    }
+    // Indicates the given word does not exist in the hash table
+    return NO_NODE;
+}
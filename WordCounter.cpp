@@ -5,7 +5,21 @@
  */
 
 #include "WordCounter.h"
+#include "WordHash.h"
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <new>
 #include <string>
+#include <system_error>
+#include <thread>
+
+// Large tables are mapped straight from the operating system where mmap is
+// available; elsewhere every table comes from new[]
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define WORD_COUNTER_USE_MMAP
+#endif
 
 using namespace std;
 
@@ -24,8 +38,9 @@ WordCounter::WordCounter(const WordCounter &other) {
 WordCounter &WordCounter::operator=(const WordCounter &rhs) {
     // Check if assignment is not to this instance
     if (this != &rhs) {
-        clear();
-        copy(rhs);
+        // Copy first, so this table is left unchanged if copying throws
+        WordCounter rhsCopy(rhs);
+        swap(rhsCopy);
     }
     return *this;
 }
@@ -34,60 +49,124 @@ WordCounter::~WordCounter() {
     clear();
 }
 
-int WordCounter::addWord(string word) {
-    int wordCount; // Word count to return
-    Node *wordNode = getWordNode(word);
+int WordCounter::addWord(const string &word) {
+    return addWord(word, NEW_WORD_COUNT);
+}
+
+int WordCounter::addWord(const string &word, int count) {
+    // A non-positive count would create a word with no occurrences, or drive
+    // counts negative
+    if (count <= 0) {
+        return getWordCount(word);
+    }
+
+    unsigned int hash = hashWord(word);
+    if (hotWords == nullptr) {
+        // Value-initialize each entry to null
+        hotWords = new Node*[HOT_WORDS_SIZE]();
+    }
+    Node *&hotWord = hotWords[hash % HOT_WORDS_SIZE];
+    hotWordLookups++;
+    // Frequent words are usually found in the hot word cache, without
+    // touching the hash table at all
+    if (hotWord != nullptr && hotWord->hash == hash && hotWord->word == word) {
+        hotWordHits++;
+        hotWord->wordCount += count;
+        totalWordCount += count;
+        return hotWord->wordCount;
+    }
+
+    int bucket = getBucket(hash, capacity);
+    Node *wordNode = moveToFront(word, hash, bucket);
 
     // If the word does not exist in the hash table
     if (wordNode == nullptr) {
-        int bucket = getBucket(word, capacity);
-        wordTable[bucket] = new Node(word, NEW_WORD_COUNT, wordTable[bucket]);
+        int node = createNode(word, hash, count, wordTable[bucket]);
+        wordTable[bucket] = node;
+        wordNode = getNode(node);
         uniqueWordCount++;
-        wordCount = wordTable[bucket]->wordCount;
+        sortedWordsValid = false;
         // Check if capacity needs to be increased
         if (getLoadFactor() > MAX_LOAD_FACTOR && capacity < MAX_CAPACITY) {
             // Resize with double capacity
             resize(capacity * 2);
         }
     } else {
-        wordNode->wordCount++;
-        wordCount = wordNode->wordCount;
+        wordNode->wordCount += count;
     }
-    totalWordCount++;
-    return wordCount;
+    totalWordCount += count;
+    // Cache the word if it is at least as frequent as the word it replaces
+    if (hotWord == nullptr || hotWord->wordCount <= wordNode->wordCount) {
+        hotWord = wordNode;
+    }
+    return wordNode->wordCount;
+}
+
+void WordCounter::addWords(const WordCounter &other) {
+    // Guard against adding a table to itself, which would resize the table
+    // while it is being traversed
+    if (this == &other) {
+        WordCounter otherCopy(other);
+        addWords(otherCopy);
+        return;
+    }
+    long long lookups = hotWordLookups, hits = hotWordHits;
+    for (int bucket = 0; bucket < other.capacity; bucket++) {
+        for (Node *curr = other.getNode(other.wordTable[bucket]);
+             curr != nullptr; curr = other.getNode(curr->next)) {
+            addWord(curr->word, curr->wordCount);
+        }
+    }
+    // Merging isn't counted as cache traffic; the other table's cache
+    // traffic is added instead, so the hit rate reflects both tables' words
+    hotWordLookups = lookups + other.hotWordLookups;
+    hotWordHits = hits + other.hotWordHits;
+}
+
+void WordCounter::removeWord(const string &word) {
+    // No word can be counted more often than this, so all of it is removed
+    removeWord(word, numeric_limits<int>::max());
 }
 
-void WordCounter::removeWord(string word) {
+void WordCounter::removeWord(const string &word, int count) {
+    // Removing a negative number of times would drive the count up
+    if (count <= 0) {
+        return;
+    }
+
+    unsigned int hash = hashWord(word);
+    int bucket = getBucket(hash, capacity);
+    Node *prev = nullptr;
+    int node = wordTable[bucket];
+    Node *current = getNode(node);
+    // Find the word within the chain of words, hashing it only once
+    while (current != nullptr &&
+           (current->hash != hash || current->word != word)) {
+        prev = current;
+        node = current->next;
+        current = getNode(node);
+    }
     // Do nothing if the word isn't in the hash table
-    if (getWordNode(word) == nullptr) {
+    if (current == nullptr) {
+        return;
+    }
+    // Only part of the word's count is removed, so the word stays
+    if (current->wordCount > count) {
+        current->wordCount -= count;
+        totalWordCount -= count;
         return;
     }
 
-    int bucket = getBucket(word, capacity);
-    // If the word is at the head of the bucket
-    if (wordTable[bucket]->word == word) {
-        Node *toDelete = wordTable[bucket];
-        updateWordCountsPostRemoval(wordTable[bucket]->wordCount);
-        wordTable[bucket] = wordTable[bucket]->next;
-        delete toDelete;
-    // If the word is not at the head of bucket but possibly within the
-    // chain of words
+    forgetHotWord(current);
+    updateWordCountsPostRemoval(current->wordCount);
+    // Skip over current to the node after current, since we're deleting
+    // current
+    if (prev == nullptr) {
+        wordTable[bucket] = current->next;
     } else {
-        Node *prev = wordTable[bucket];
-        for (Node *current = wordTable[bucket]->next; current != nullptr;
-             current = current->next) {
-            // If the word is found
-            if (current->word == word) {
-                updateWordCountsPostRemoval(current->wordCount);
-                // Skip over current to the node after current, since we're
-                // deleting current
-                prev->next = current->next;
-                delete current;
-                break;
-            }
-            prev = prev->next;
-        }
+        prev->next = current->next;
     }
+    destroyNode(node);
     // Check if capacity needs to be decreased
     if (getLoadFactor() < MIN_LOAD_FACTOR && capacity > MIN_CAPACITY) {
         // Resize with half capacity
@@ -95,7 +174,22 @@ void WordCounter::removeWord(string word) {
     }
 }
 
-int WordCounter::getWordCount(string word) const {
+void WordCounter::removeWords(const WordCounter &other) {
+    // Removing a table from itself just empties it
+    if (this == &other) {
+        WordCounter otherCopy(other);
+        removeWords(otherCopy);
+        return;
+    }
+    for (int bucket = 0; bucket < other.capacity; bucket++) {
+        for (Node *curr = other.getNode(other.wordTable[bucket]);
+             curr != nullptr; curr = other.getNode(curr->next)) {
+            removeWord(curr->word, curr->wordCount);
+        }
+    }
+}
+
+int WordCounter::getWordCount(const string &word) const {
     Node *wordNode = getWordNode(word);
     // Return the word count or 0 if not in the word table
     return wordNode == nullptr ? 0 : wordNode->wordCount;
@@ -121,6 +215,202 @@ int WordCounter::getCapacity() const {
     return capacity;
 }
 
+double WordCounter::getHotWordHitRate() const {
+    return hotWordLookups == 0 ? 0 : (double) hotWordHits / hotWordLookups;
+}
+
+int WordCounter::getLongestChainLength() const {
+    int longest = 0;
+    for (int bucket = 0; bucket < capacity; bucket++) {
+        int length = 0;
+        for (Node *curr = getNode(wordTable[bucket]); curr != nullptr;
+             curr = getNode(curr->next)) {
+            length++;
+        }
+        longest = max(longest, length);
+    }
+    return longest;
+}
+
+void WordCounter::forEachWord(
+        const function<void(const string &, int)> &visit) const {
+    for (int bucket = 0; bucket < capacity; bucket++) {
+        for (Node *curr = getNode(wordTable[bucket]); curr != nullptr;
+             curr = getNode(curr->next)) {
+            visit(curr->word, curr->wordCount);
+        }
+    }
+}
+
+void WordCounter::save(ostream &output) const {
+    output << capacity << ' ' << hotWordLookups << ' ' << hotWordHits << '\n';
+    for (int bucket = 0; bucket < capacity; bucket++) {
+        for (Node *curr = getNode(wordTable[bucket]); curr != nullptr;
+             curr = getNode(curr->next)) {
+            output << curr->word.length() << ' ' << curr->word << ' '
+                   << curr->wordCount << '\n';
+        }
+    }
+}
+
+bool WordCounter::load(istream &input) {
+    int savedCapacity;
+    long long lookups, hits;
+    if (!(input >> savedCapacity >> lookups >> hits) ||
+        savedCapacity < MIN_CAPACITY || savedCapacity > MAX_CAPACITY ||
+        hits < 0 || hits > lookups) {
+        return false;
+    }
+    // Read into a separate table, leaving this one untouched until the whole
+    // snapshot has been read. The table grows with the words actually read,
+    // so a bogus saved capacity can't allocate a huge table up front
+    WordCounter loaded;
+
+    int length, wordCount;
+    while (input >> length) {
+        if (length < 0 || input.get() != ' ') {
+            return false;
+        }
+        // Read the word in bounded chunks, so a bogus length fails at the
+        // end of the stream rather than allocating that much memory first
+        string word;
+        while ((int) word.length() < length) {
+            int start = word.length();
+            int chunkLength = min(length - start, (int) LOAD_CHUNK_SIZE);
+            word.resize(start + chunkLength);
+            if (!input.read(&word[start], chunkLength)) {
+                return false;
+            }
+        }
+        if (!(input >> wordCount) || wordCount <= 0) {
+            return false;
+        }
+        loaded.addWord(word, wordCount);
+    }
+    if (!input.eof()) {
+        return false;
+    }
+
+    // Restore the saved capacity only if it suits the words actually read
+    int maxCapacity = getValidCapacity(
+            (int) (loaded.uniqueWordCount / MIN_LOAD_FACTOR));
+    if (savedCapacity != loaded.capacity && savedCapacity <= maxCapacity &&
+        savedCapacity * MAX_LOAD_FACTOR >= loaded.uniqueWordCount) {
+        loaded.resize(savedCapacity);
+    }
+    // Like a copy, the table keeps the saved hit rate rather than counting
+    // the lookups made while loading
+    loaded.hotWordLookups = lookups;
+    loaded.hotWordHits = hits;
+    swap(loaded);
+    return true;
+}
+
+void WordCounter::buildPrefixIndex() {
+    sortedWords.clear();
+    sortedWords.reserve(uniqueWordCount);
+    for (int bucket = 0; bucket < capacity; bucket++) {
+        for (Node *curr = getNode(wordTable[bucket]); curr != nullptr;
+             curr = getNode(curr->next)) {
+            sortedWords.push_back(curr);
+        }
+    }
+    sort(sortedWords.begin(), sortedWords.end(),
+         [](const Node *lhs, const Node *rhs) {
+             return lhs->word < rhs->word;
+         });
+    sortedWordsValid = true;
+}
+
+vector<pair<string, int>> WordCounter::getWordsWithPrefix(const string &prefix,
+                                                          int maxWords) const {
+    vector<Node *> matches;
+    if (sortedWordsValid) {
+        // Words sharing the prefix are next to each other in sorted order,
+        // starting at the first word not less than the prefix
+        auto first = lower_bound(sortedWords.begin(), sortedWords.end(),
+                                 prefix,
+                                 [](const Node *node, const string &prefix) {
+                                     return node->word < prefix;
+                                 });
+        for (auto it = first; it != sortedWords.end() &&
+             (*it)->word.compare(0, prefix.length(), prefix) == 0; ++it) {
+            matches.push_back(*it);
+        }
+    } else {
+        // The index is out of date, so check every word instead
+        for (int bucket = 0; bucket < capacity; bucket++) {
+            for (Node *curr = getNode(wordTable[bucket]); curr != nullptr;
+                 curr = getNode(curr->next)) {
+                if (curr->word.compare(0, prefix.length(), prefix) == 0) {
+                    matches.push_back(curr);
+                }
+            }
+        }
+    }
+
+    // Only the top maxWords matches need to be ranked
+    int resultCount = max(0, min(maxWords, (int) matches.size()));
+    partial_sort(matches.begin(), matches.begin() + resultCount,
+                 matches.end(), ranksBefore);
+    vector<pair<string, int>> words;
+    for (int i = 0; i < resultCount; i++) {
+        words.emplace_back(matches[i]->word, matches[i]->wordCount);
+    }
+    return words;
+}
+
+vector<string> WordCounter::getSimilarWords(const string &word) const {
+    // Characters that can appear in a cleaned word
+    const string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789'-";
+    int length = word.length();
+    vector<Node *> matches;
+    // Records the candidate's Node if the candidate is in the hash table
+    auto lookUp = [&](const string &candidate) {
+        Node *node = getWordNode(candidate);
+        // Different edits can produce the same word, so skip repeats
+        if (node != nullptr && candidate != word &&
+            find(matches.begin(), matches.end(), node) == matches.end()) {
+            matches.push_back(node);
+        }
+    };
+
+    string candidate;
+    for (int i = 0; i <= length; i++) {
+        // Delete the character at i
+        if (i < length) {
+            candidate = word;
+            candidate.erase(i, 1);
+            lookUp(candidate);
+        }
+        // Swap the characters at i and i + 1
+        if (i + 1 < length) {
+            candidate = word;
+            std::swap(candidate[i], candidate[i + 1]);
+            lookUp(candidate);
+        }
+        for (char c : alphabet) {
+            // Replace the character at i
+            if (i < length) {
+                candidate = word;
+                candidate[i] = c;
+                lookUp(candidate);
+            }
+            // Insert a character before i
+            candidate = word;
+            candidate.insert(i, 1, c);
+            lookUp(candidate);
+        }
+    }
+
+    sort(matches.begin(), matches.end(), ranksBefore);
+    vector<string> words;
+    for (Node *match : matches) {
+        words.push_back(match->word);
+    }
+    return words;
+}
+
 int WordCounter::getValidCapacity(int capacity) {
     // Array of valid prime numbers
     const int primes[] = {
@@ -150,102 +440,307 @@ int WordCounter::getValidCapacity(int capacity) {
     return MAX_CAPACITY;
 }
 
+int *WordCounter::allocateTable(int capacity) {
+#ifdef WORD_COUNTER_USE_MMAP
+    if (capacity >= MMAP_MIN_CAPACITY) {
+        // Anonymous mappings are zero-filled on demand by the kernel, so
+        // there is no need to set each bucket to NO_NODE (0) here
+        void *table = mmap(nullptr, capacity * sizeof(int),
+                           PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1, 0);
+        if (table == MAP_FAILED) {
+            throw bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        // Ask for transparent huge pages to cut TLB misses on random bucket
+        // access; this is only a hint, so failure is ignored
+        madvise(table, capacity * sizeof(int), MADV_HUGEPAGE);
+#endif
+        return static_cast<int *>(table);
+    }
+#endif
+    // Value-initialize each bucket to NO_NODE (0)
+    return new int[capacity]();
+}
+
+void WordCounter::deallocateTable(int *table, int capacity) {
+#ifdef WORD_COUNTER_USE_MMAP
+    if (capacity >= MMAP_MIN_CAPACITY) {
+        munmap(table, capacity * sizeof(int));
+        return;
+    }
+#endif
+    delete[] table;
+}
+
 void WordCounter::initialize(int capacity) {
     this->capacity = capacity;
     totalWordCount = 0;
     uniqueWordCount = 0;
-    // Initialize array of Node pointers
-    wordTable = new Node*[capacity];
-    for (int bucket = 0; bucket < this->capacity; bucket++) {
-        // Initialize each bucket to null
-        wordTable[bucket] = nullptr;
-    }
+    // Initialize array of empty buckets
+    wordTable = allocateTable(capacity);
+    // Slot 0 of the pool is never used, since index 0 is NO_NODE
+    nodeCount = 1;
+    freeNode = NO_NODE;
+    hotWordLookups = 0;
+    hotWordHits = 0;
 }
 
-int WordCounter::getBucket(string word, int capacity) {
-    hash<string> h;
-    return h(word) % capacity;
+int WordCounter::getBucket(unsigned int hash, int capacity) {
+    return hash % capacity;
 }
 
-WordCounter::Node *WordCounter::getWordNode(string word) const {
-    int bucket = getBucket(word, capacity);
+WordCounter::Node *WordCounter::getWordNode(const string &word) const {
+    unsigned int hash = hashWord(word);
+    int bucket = getBucket(hash, capacity);
     // Look through entire linked list at the hash index
-    for (Node *curr = wordTable[bucket]; curr != nullptr; curr = curr->next) {
+    for (Node *curr = getNode(wordTable[bucket]); curr != nullptr;
+         curr = getNode(curr->next)) {
+        // If the given word is found (checking the hash first, since it is
+        // far cheaper to compare than the word)
+        if (curr->hash == hash && curr->word == word) {
+            return curr;
+        }
+    }
+    // Indicates the given word does not exist in the hash table
+    return nullptr;
+}
+
+bool WordCounter::ranksBefore(const Node *lhs, const Node *rhs) {
+    if (lhs->wordCount != rhs->wordCount) {
+        return lhs->wordCount > rhs->wordCount;
+    }
+    return lhs->word < rhs->word;
+}
+
+WordCounter::Node *WordCounter::moveToFront(const string &word,
+                                            unsigned int hash, int bucket) {
+    Node *prev = nullptr;
+    for (int node = wordTable[bucket]; node != NO_NODE; ) {
+        Node *curr = getNode(node);
         // If the given word is found
-        if (curr->word == word) {
+        if (curr->hash == hash && curr->word == word) {
+            // Unlink it and put it at the head of the bucket, unless it is
+            // already there
+            if (prev != nullptr) {
+                prev->next = curr->next;
+                curr->next = wordTable[bucket];
+                wordTable[bucket] = node;
+            }
             return curr;
         }
+        prev = curr;
+        node = curr->next;
     }
     // Indicates the given word does not exist in the hash table
     return nullptr;
 }
 
+void WordCounter::clearHotWords() {
+    delete[] hotWords;
+    hotWords = nullptr;
+}
+
+void WordCounter::forgetHotWord(const Node *node) {
+    if (hotWords == nullptr) {
+        return;
+    }
+    Node *&hotWord = hotWords[node->hash % HOT_WORDS_SIZE];
+    if (hotWord == node) {
+        hotWord = nullptr;
+    }
+}
+
 void WordCounter::updateWordCountsPostRemoval(int toSubtract) {
     totalWordCount -= toSubtract;
     uniqueWordCount--;
+    sortedWordsValid = false;
 }
 
 void WordCounter::copy(const WordCounter &other) {
     capacity = other.capacity;
     totalWordCount = other.totalWordCount;
     uniqueWordCount = other.uniqueWordCount;
-    wordTable = new Node*[capacity];
-    // Copy linked list in each bucket
-    for (int bucket = 0; bucket < capacity; bucket++) {
-        wordTable[bucket] = copyBucket(other.wordTable[bucket]);
+    hotWordLookups = other.hotWordLookups;
+    hotWordHits = other.hotWordHits;
+    nodeCount = other.nodeCount;
+    freeNode = other.freeNode;
+    wordTable = allocateTable(capacity);
+    try {
+        // Nodes are linked by index, so copying the buckets and every block
+        // of the pool as they are copies each linked list (and the free list)
+        std::copy(other.wordTable, other.wordTable + capacity, wordTable);
+        nodeBlocks.assign(other.nodeBlocks.size(), nullptr);
+        forEachBlockRange(nodeBlocks.size(), uniqueWordCount,
+                          [this, &other](int first, int last) {
+            for (int block = first; block < last; block++) {
+                nodeBlocks[block] = new Node[NODE_BLOCK_SIZE];
+                std::copy(other.nodeBlocks[block],
+                          other.nodeBlocks[block] + NODE_BLOCK_SIZE,
+                          nodeBlocks[block]);
+            }
+        });
+    } catch (...) {
+        // Free the blocks copied so far (the rest are still null)
+        clear();
+        throw;
+    }
+}
+
+void WordCounter::swap(WordCounter &other) {
+    std::swap(capacity, other.capacity);
+    std::swap(totalWordCount, other.totalWordCount);
+    std::swap(uniqueWordCount, other.uniqueWordCount);
+    std::swap(hotWordLookups, other.hotWordLookups);
+    std::swap(hotWordHits, other.hotWordHits);
+    std::swap(wordTable, other.wordTable);
+    std::swap(nodeBlocks, other.nodeBlocks);
+    std::swap(nodeCount, other.nodeCount);
+    std::swap(freeNode, other.freeNode);
+    std::swap(sortedWords, other.sortedWords);
+    std::swap(sortedWordsValid, other.sortedWordsValid);
+    std::swap(hotWords, other.hotWords);
+}
+
+WordCounter::Node *WordCounter::getNode(int node) const {
+    if (node == NO_NODE) {
+        return nullptr;
+    }
+    return &nodeBlocks[node / NODE_BLOCK_SIZE][node % NODE_BLOCK_SIZE];
+}
+
+int WordCounter::createNode(const string &word, unsigned int hash,
+                            int wordCount, int next) {
+    int node;
+    // Reuse a Node freed by removeWord before taking a new one
+    if (freeNode != NO_NODE) {
+        node = freeNode;
+        freeNode = getNode(node)->next;
+    } else {
+        // Every block is in use (or there are none yet), so add another one
+        // to the pool
+        if (nodeCount >= (int) nodeBlocks.size() * NODE_BLOCK_SIZE) {
+            nodeBlocks.push_back(nullptr);
+            try {
+                nodeBlocks.back() = new Node[NODE_BLOCK_SIZE];
+            } catch (...) {
+                nodeBlocks.pop_back();
+                throw;
+            }
+        }
+        node = nodeCount++;
     }
+    Node *newNode = getNode(node);
+    newNode->word = word;
+    newNode->hash = hash;
+    newNode->wordCount = wordCount;
+    newNode->next = next;
+    return node;
+}
+
+void WordCounter::destroyNode(int node) {
+    Node *oldNode = getNode(node);
+    // Release the word's memory now, rather than when the Node is reused
+    string().swap(oldNode->word);
+    oldNode->next = freeNode;
+    freeNode = node;
 }
 
-WordCounter::Node *WordCounter::copyBucket(WordCounter::Node *headToCopy) {
-    // Anchor node to point to the head Node to eventually return
-    Node anchor("", 0), *current, *tail;
-    tail = &anchor;
-    // Traverse the linked list to be copied
-    for (current = headToCopy; current != nullptr; current = current->next) {
-        tail->next = new Node(current->word, current->wordCount);
-        tail = tail->next;
+void WordCounter::forEachBlockRange(int blockCount, int wordCount,
+                                    const function<void(int, int)> &task) {
+    int threadCount = 1;
+    // Threads only pay off when there are many Node objects to process, not
+    // merely many (possibly empty) buckets
+    if (wordCount >= PARALLEL_MIN_WORDS) {
+        // hardware_concurrency may return 0 if it can't be determined
+        threadCount = max(1, (int) thread::hardware_concurrency());
+    }
+    if (threadCount == 1) {
+        task(0, blockCount);
+        return;
+    }
+
+    int rangeSize = blockCount / threadCount + 1;
+    int rangeCount = (blockCount + rangeSize - 1) / rangeSize;
+    // An exception escaping a thread would terminate the program, so the
+    // exception thrown by each range (if any) is kept for the calling thread
+    vector<exception_ptr> errors(rangeCount);
+    auto runRange = [&task, &errors](int range, int first, int last) {
+        try {
+            task(first, last);
+        } catch (...) {
+            errors[range] = current_exception();
+        }
+    };
+
+    vector<thread> threads;
+    threads.reserve(rangeCount);
+    // Hand each thread its own contiguous range of blocks
+    for (int range = 0; range < rangeCount; range++) {
+        int first = range * rangeSize;
+        try {
+            threads.emplace_back(runRange, range, first,
+                                 min(first + rangeSize, blockCount));
+        } catch (const system_error &) {
+            // No more threads can be started (clear runs from the noexcept
+            // destructor, so this must not throw), so process the remaining
+            // blocks on the calling thread instead
+            runRange(range, first, blockCount);
+            break;
+        }
+    }
+    for (thread &t : threads) {
+        t.join();
+    }
+    for (const exception_ptr &error : errors) {
+        if (error) {
+            rethrow_exception(error);
+        }
     }
-    return anchor.next;
 }
 
 void WordCounter::resize(int newCapacity) {
     newCapacity = getValidCapacity(newCapacity);
     // Initialize the new hash table
-    Node **newWordTable = new Node*[newCapacity];
-    for (int bucket = 0; bucket < newCapacity; bucket++) {
-        newWordTable[bucket] = nullptr;
-    }
+    int *newWordTable = allocateTable(newCapacity);
     // Iterate through original hash table
     for (int bucket = 0; bucket < capacity; bucket++) {
-        Node *originalNode = wordTable[bucket];
+        int node = wordTable[bucket];
         // Iterate through original table's linked list
-        while (originalNode != nullptr) {
-            string word = originalNode->word;
-            // Rehash word using the new capacity
-            int newBucket = getBucket(word, newCapacity);
-            newWordTable[newBucket] = new Node(word, originalNode->wordCount,
-                                               newWordTable[newBucket]);
-            originalNode = originalNode->next;
+        while (node != NO_NODE) {
+            Node *originalNode = getNode(node);
+            int next = originalNode->next;
+            // Rehash word using the new capacity (from its stored hash, so
+            // the word itself isn't rehashed), and move the existing Node to
+            // the front of its new bucket rather than copying it
+            int newBucket = getBucket(originalNode->hash, newCapacity);
+            originalNode->next = newWordTable[newBucket];
+            newWordTable[newBucket] = node;
+            node = next;
         }
     }
-    // Delete old hash table contents after copying data to new hash table
-    clear();
+    // Every Node now lives in the new table, so only the old array is freed
+    deallocateTable(wordTable, capacity);
     // Update capacity value and wordTable pointer
     capacity = newCapacity;
     wordTable = newWordTable;
 }
 
 void WordCounter::clear() {
-    for (int bucket = 0; bucket < capacity; bucket++) {
-        // Delete each node in the bucket
-        while (wordTable[bucket] != nullptr) {
-            Node *toDelete = wordTable[bucket];
-            wordTable[bucket] = wordTable[bucket]->next;
-            delete toDelete;
+    forEachBlockRange(nodeBlocks.size(), uniqueWordCount,
+                      [this](int first, int last) {
+        // Delete each block of Node objects in the range
+        for (int block = first; block < last; block++) {
+            delete[] nodeBlocks[block];
         }
-    }
-    delete[] wordTable;
+    });
+    nodeBlocks.clear();
+    deallocateTable(wordTable, capacity);
     wordTable = nullptr;
+    // The index and cache point at the Node objects that were just deleted
+    sortedWords.clear();
+    sortedWordsValid = false;
+    clearHotWords();
 }
 
 
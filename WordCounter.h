@@ -1,6 +1,9 @@
 #pragma once
 
+#include <functional>
+#include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -13,6 +16,12 @@
  * automatically resizes when the load factor exceeds or drops below a certain
  * threshold to ensure optimal performance.
  *
+ * Like in FixedWordCounter, Node objects are kept in a pool and linked by
+ * their 32-bit index into it rather than by pointer, which halves the size of
+ * the buckets. The pool grows in blocks of Node objects (so a Node never
+ * moves once created, and isn't a separate heap allocation), and Node objects
+ * freed by removeWord are reused by later words rather than returned.
+ *
  * @author  Francis Kogge
  * @version 1.0
  * @date    12/28/2020
@@ -66,7 +75,28 @@ public:
      * @param word Word to add to the hash table
      * @return     Number of times the word has been added to the table
      */
-    int addWord(std::string word);
+    int addWord(const std::string &word);
+
+    /**
+     * Adds a word to the hash table the given number of times, as if add had
+     * been called count times on that word. Returns the number of times the
+     * given word has appeared in the hash table. A count of 0 or less is
+     * ignored, leaving the hash table unchanged.
+     *
+     * @param word  Word to add to the hash table
+     * @param count Number of times to add the word
+     * @return      Number of times the word has been added to the table
+     */
+    int addWord(const std::string &word, int count);
+
+    /**
+     * Adds every word in the other WordCounter to this hash table, along
+     * with its count. Useful for combining WordCounter objects that were
+     * filled separately (for example, on different threads).
+     *
+     * @param other WordCounter object whose words are added
+     */
+    void addWords(const WordCounter &other);
 
     /**
      * Removes the given word (the Node object associated with the word and all
@@ -74,7 +104,27 @@ public:
      *
      * @param word Word to remove
      */
-    void removeWord(std::string word);
+    void removeWord(const std::string &word);
+
+    /**
+     * Subtracts the given number from the count of the given word, undoing
+     * that many calls to add. If the count drops to 0 or below, the word is
+     * removed from the hash table entirely. A count of 0 or less is ignored,
+     * leaving the hash table unchanged.
+     *
+     * @param word  Word to remove
+     * @param count Number of times to remove the word
+     */
+    void removeWord(const std::string &word, int count);
+
+    /**
+     * Subtracts the count of every word in the other WordCounter from this
+     * hash table, undoing a previous call to addWords with the same
+     * WordCounter.
+     *
+     * @param other WordCounter object whose words are removed
+     */
+    void removeWords(const WordCounter &other);
 
     /**
      * Returns the count of the given word in the hash table.
@@ -83,7 +133,7 @@ public:
      * @return     Count of the given word, or 0 if the word doesn't exist in
      *             the hash table
      */
-    int getWordCount(std::string word) const;
+    int getWordCount(const std::string &word) const;
 
     /**
      * Returns the current load factor of the hash table.
@@ -122,10 +172,113 @@ public:
      */
     int getCapacity() const;
 
+    /**
+     * Returns the number of words in the longest chain (bucket) of the hash
+     * table, which bounds the number of comparisons a single lookup can take.
+     *
+     * @return Length of the longest chain
+     */
+    int getLongestChainLength() const;
+
+    /**
+     * Returns the fraction of addWord calls whose word was found in the hot
+     * word cache, a small cache of the most frequently added words that is
+     * checked before the hash table itself.
+     *
+     * @return Hot word cache hit rate, or 0 if no words have been added
+     */
+    double getHotWordHitRate() const;
+
+    /**
+     * Calls visit once for each word in the hash table, with the word and its
+     * count. Words are visited in no particular order, and the hash table
+     * must not be modified during the visit.
+     *
+     * @param visit Function called with each word and its count
+     */
+    void forEachWord(
+            const std::function<void(const std::string &, int)> &visit) const;
+
+    /**
+     * Writes a snapshot of the hash table to the given output stream: the
+     * capacity and the hot word cache's lookup and hit counts (so the hit
+     * rate survives a reload) on the first line, followed by one line per
+     * word containing the length of the word, the word itself, and its
+     * count, separated by single spaces. Since the length is written first,
+     * words may contain any characters (including spaces and newlines) or be
+     * empty.
+     *
+     * @param output Stream to write the snapshot to
+     */
+    void save(std::ostream &output) const;
+
+    /**
+     * Replaces the contents of the hash table with a snapshot read from the
+     * given input stream (in the format written by save). Reading stops at
+     * the end of the stream or at the first malformed line; if the snapshot
+     * is malformed, the hash table is left unchanged. The saved capacity is
+     * only a hint: it must lie within the allowed capacities, and is used
+     * only if it suits the number of words actually read.
+     *
+     * @param input Stream to read the snapshot from
+     * @return      True if the entire snapshot was read
+     *              False if the snapshot was malformed
+     */
+    bool load(std::istream &input);
+
+    /**
+     * Builds a sorted index of the words in the hash table, which lets
+     * getWordsWithPrefix visit only the matching words. Adding a new word to
+     * or removing a word from the hash table makes the index out of date, so
+     * it should be built once the table is done changing.
+     */
+    void buildPrefixIndex();
+
+    /**
+     * Returns the words in the hash table that start with the given prefix,
+     * along with their counts, ordered from highest to lowest count (ties
+     * ordered alphabetically). Queries are answered from the index built by
+     * buildPrefixIndex if it is up to date, otherwise every word in the hash
+     * table is checked. The hash table is not modified, so concurrent calls
+     * on the same object are safe as long as nothing modifies it.
+     *
+     * @param prefix   Prefix to match
+     * @param maxWords Maximum number of words to return
+     * @return         Up to maxWords words starting with prefix, each paired
+     *                 with its count
+     */
+    std::vector<std::pair<std::string, int>> getWordsWithPrefix(
+            const std::string &prefix, int maxWords) const;
+
+    /**
+     * Returns the words in the hash table that are within edit distance 1 of
+     * the given word (one character inserted, deleted, replaced, or two
+     * adjacent characters swapped), ordered from highest to lowest count
+     * (ties ordered alphabetically). The given word itself is not included.
+     * Each possible edit is looked up directly in the hash table, so the
+     * cost depends on the length of the word, not the size of the table.
+     *
+     * @param word Word to find similar words for (e.g. a misspelling)
+     * @return     Words one edit away from the given word
+     */
+    std::vector<std::string> getSimilarWords(const std::string &word) const;
+
 private:
     static const int MIN_CAPACITY = 11; // Minimum default capacity
     static const int MAX_CAPACITY = 993815743; // Maximum allowed capacity
     static const int NEW_WORD_COUNT = 1; // Initial count when new word is added
+    static const int PARALLEL_MIN_WORDS = 65536; // Minimum unique words for
+                                                 // multithreaded copy/clear
+    static const int HOT_WORDS_SIZE = 256; // Number of entries in the hot
+                                           // word cache
+    static const int MMAP_MIN_CAPACITY = 65536; // Minimum capacity for
+                                                // allocating via mmap
+    static const int LOAD_CHUNK_SIZE = 4096; // Most bytes of a word that load
+                                             // reads at once
+    static const int NODE_BLOCK_SIZE = 64; // Number of Node objects allocated
+                                           // at once for the pool
+    static const int NO_NODE = 0; // Index representing a null link (so a
+                                  // zero-filled table has empty buckets)
     const double MAX_LOAD_FACTOR = 0.750, MIN_LOAD_FACTOR = 0.30;
 
     /*
@@ -133,28 +286,35 @@ private:
      */
     struct Node {
         std::string word; // Word to add
-        Node *next; // Next Node in the table
+        int next; // Index of the next Node in the bucket (or free list)
+        unsigned int hash; // Hash of the word (compared before the word
+                           // itself, and reused when resizing)
         int wordCount; // Number of times the given word has been added
-
-        /**
-         * Convenience constructor
-         *
-         * @param word Word to add
-         */
-        Node(std::string word, int wordCount, Node *next = nullptr) {
-            this->word = word;
-            this->next = next;
-            this->wordCount = wordCount;
-        }
-
     };
 
     int capacity; // Capacity of hash table
     int totalWordCount; // Total number of words added
     int uniqueWordCount; // Number of unique words added
-    Node **wordTable; // Hash table (array of Node pointers) of linked Node
-                      // objects containing data associated with each word
-                      // the Node represents
+    long long hotWordLookups; // Number of addWord calls made
+    long long hotWordHits; // Number of addWord calls answered by hotWords
+    int *wordTable; // Hash table (array of head Node indices) of linked
+                    // Node objects containing data associated with each
+                    // word the Node represents
+    std::vector<Node *> nodeBlocks; // Pool of every Node, in blocks of
+                                    // NODE_BLOCK_SIZE; Node i is entry
+                                    // i % NODE_BLOCK_SIZE of block
+                                    // i / NODE_BLOCK_SIZE
+    int nodeCount; // Number of Node objects taken from the pool, including
+                   // the unused Node 0
+    int freeNode; // Index of the first Node freed by removeWord, or NO_NODE
+    std::vector<Node *> sortedWords; // Nodes in alphabetical order by word,
+                                     // for prefix queries
+    bool sortedWordsValid = false; // Whether sortedWords matches the words
+                                   // currently in the table
+    Node **hotWords = nullptr; // Direct-mapped cache (indexed by hash) of
+                               // HOT_WORDS_SIZE Node objects for frequent
+                               // words, allocated on the first addWord call
+                               // (copies start out with an empty cache)
 
     /**
      * Returns a valid, prime-number capacity to initialize the hash table
@@ -165,6 +325,27 @@ private:
      */
     static int getValidCapacity(int capacity);
 
+    /**
+     * Returns a new hash table (array of Node indices) with every bucket set
+     * to NO_NODE. On platforms with mmap, large tables are mapped directly from
+     * the operating system, so their zeroed pages are only faulted in once a
+     * bucket is touched, and are backed by transparent huge pages where
+     * supported.
+     *
+     * @param capacity Capacity of the table
+     * @return         New table of empty buckets
+     */
+    static int *allocateTable(int capacity);
+
+    /**
+     * Frees a hash table previously returned by allocateTable. Does not
+     * delete the Node objects in the table.
+     *
+     * @param table    Table to free
+     * @param capacity Capacity the table was allocated with
+     */
+    static void deallocateTable(int *table, int capacity);
+
     /**
      * Helper method for initializing the hash table and other data members.
      *
@@ -173,13 +354,13 @@ private:
     void initialize(int capacigty);
 
     /**
-     * Returns bucket index for the given word via std::hash.
+     * Returns bucket index for the given hash (from hashWord).
      *
-     * @param word     Word to hash
+     * @param hash     Hash of the word
      * @param capacity Capacity of the table
      * @return         Bucket index
      */
-    static int getBucket(std::string word, int capacity);
+    static int getBucket(unsigned int hash, int capacity);
 
     /**
      * Returns the Node object which contains the given word, or null if no
@@ -190,7 +371,45 @@ private:
      * @return     Node object with the given word, or nullptr if the word does
      *             not exist in the hash table
      */
-    Node *getWordNode(std::string word) const;
+    Node *getWordNode(const std::string &word) const;
+
+    /**
+     * Returns the Node object which contains the given word, like getWordNode,
+     * and moves that Node to the head of its bucket. Frequently added words
+     * thereby stay near the front of their chains, so later lookups of those
+     * words take fewer comparisons.
+     *
+     * @param word   Word to look up in hash table
+     * @param hash   Hash of the word
+     * @param bucket Bucket index of the word
+     * @return       Node object with the given word, or nullptr if the word
+     *               does not exist in the hash table
+     */
+    Node *moveToFront(const std::string &word, unsigned int hash, int bucket);
+
+    /**
+     * Returns whether lhs ranks before rhs when ordering words from highest
+     * to lowest count (ties ordered alphabetically).
+     *
+     * @param lhs Node on the left-hand side of the comparison
+     * @param rhs Node on the right-hand side of the comparison
+     * @return    True if lhs ranks before rhs
+     */
+    static bool ranksBefore(const Node *lhs, const Node *rhs);
+
+    /**
+     * Frees the hot word cache (without resetting its hit rate). The cache
+     * is allocated again on the next addWord call.
+     */
+    void clearHotWords();
+
+    /**
+     * Removes the given Node from the hot word cache, if it is cached. Must
+     * be called before the Node is returned to the pool.
+     *
+     * @param node Node about to be removed from the hash table
+     */
+    void forgetHotWord(const Node *node);
 
     /**
      * Updates the total and unique word counts after removing an entry from
@@ -209,28 +428,75 @@ private:
     void copy(const WordCounter &other);
 
     /**
-     * Helper method for copying an entire bucket (the linked list in the
-     * given bucket). Returns the head Node of that bucket (which is chained
-     * to all other Node objects in the bucket).
+     * Helper method for exchanging the hash table and other data members of
+     * this WordCounter with those of the other WordCounter.
+     *
+     * @param other WordCounter object to swap with
+     */
+    void swap(WordCounter &other);
+
+    /**
+     * Returns the Node object with the given index in the pool, or null if
+     * the index is NO_NODE.
+     *
+     * @param node Index of the Node
+     * @return     Node object with the given index, or nullptr
+     */
+    Node *getNode(int node) const;
+
+    /**
+     * Takes a Node object from the pool (reusing one freed by destroyNode if
+     * there is one, otherwise adding a block to the pool if it is full) and
+     * fills it in. Does not link the Node into the hash table.
+     *
+     * @param word      Word to add
+     * @param hash      Hash of the word
+     * @param wordCount Number of times the word has been added
+     * @param next      Index of the next Node in the bucket
+     * @return          Index of the new Node
+     */
+    int createNode(const std::string &word, unsigned int hash, int wordCount,
+                   int next);
+
+    /**
+     * Returns a Node object, which must already be unlinked from the hash
+     * table, to the pool for reuse.
+     *
+     * @param node Index of the Node
+     */
+    void destroyNode(int node);
+
+    /**
+     * Splits the block indices [0, blockCount) of the pool into contiguous
+     * ranges and calls task on each range. Tables holding many words are
+     * split across multiple threads (one range per thread), otherwise task is
+     * called once on the calling thread with the entire range. If a thread
+     * can't be started, the remaining blocks are processed on the calling
+     * thread. If task throws on any range, the exception is rethrown on the
+     * calling thread once every range has finished.
      *
-     * @param headToCopy Bucket head to be copied
-     * @return           Copy of the head Node passed in as an argument,
-     *                   chained to all other nodes in the bucket
+     * @param blockCount Number of blocks to process
+     * @param wordCount  Number of words in the blocks
+     * @param task       Function called with the first block (inclusive) and
+     *                   last block (exclusive) of each range
      */
-    static Node *copyBucket(Node *headToCopy);
+    static void forEachBlockRange(int blockCount, int wordCount,
+                                  const std::function<void(int, int)> &task);
 
     /**
      * Resizes the hash table to fit the new given capacity. If newCapacity is
      * less than the current capacity, the hash table will be shrunk to the
      * new capacity. If newCapacity is larger than the current capacity, it
-     * will be expanded to the new capacity.
+     * will be expanded to the new capacity. Existing Node objects are moved
+     * into the new table, not copied.
      *
      * @param newCapacity New capacity to resize hash table to
      */
     void resize(int newCapacity);
 
     /**
-     * Helper method for deleting each Node in each bucket in the hash table.
+     * Helper method for deleting every Node in the pool, along with the hash
+     * table itself.
      */
     void clear();
 };
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Returns the 64-bit FNV-1a hash of the given word, folded to 32 bits. Unlike
+ * std::hash, the result is the same in every process and build, so a hash
+ * table's layout doesn't depend on the program that created it. Shared by
+ * WordCounter and FixedWordCounter.
+ *
+ * @param word Word to hash
+ * @return     Hash of the word
+ */
+inline unsigned int hashWord(const std::string &word) {
+    const unsigned long long offsetBasis = 14695981039346656037ULL;
+    const unsigned long long prime = 1099511628211ULL;
+    unsigned long long hash = offsetBasis;
+    // Mix in each byte of the word
+    for (char c : word) {
+        hash ^= (unsigned char) c;
+        hash *= prime;
+    }
+    // Fold the upper half into the lower half, so no bits are wasted
+    return (unsigned int) (hash ^ (hash >> 32));
+}
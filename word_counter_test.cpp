@@ -7,14 +7,113 @@
  * @date    12/28/2020
  */
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include "WordCounter.h"
+#include "FixedWordCounter.h"
 #include "English.h"
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace std;
 
+const int READ_BUFFER_SIZE = 1 << 20; // Bytes read from the file per read call
+const string GZIP_EXTENSION = ".gz"; // File name suffix of gzip input files
+const int MAX_PREFIX_MATCHES = 10; // Words displayed per prefix query
+const int MAX_SUGGESTIONS = 3; // Similar words suggested per unknown word
+const string STEM_OPTION = "--stem"; // Command line option to count stems
+const int MAX_FIXED_WORDS = 64; // Unique words held by FixedWordCounter test
+
+#ifdef HAVE_ZLIB
+/**
+ * Stream buffer which decompresses a gzip file as it is read, so compressed
+ * input can be tokenized directly instead of being decompressed to a
+ * temporary file first.
+ */
+class GzipStreamBuffer : public streambuf {
+public:
+    /**
+     * Constructor - opens the given gzip file for reading.
+     *
+     * @param fileName Name of the gzip file
+     */
+    explicit GzipStreamBuffer(const string &fileName)
+            : failed(false), buffer(READ_BUFFER_SIZE) {
+        file = gzopen(fileName.c_str(), "rb");
+        if (file != nullptr) {
+            gzbuffer(file, READ_BUFFER_SIZE);
+        }
+    }
+
+    /**
+     * Destructor - closes the gzip file.
+     */
+    ~GzipStreamBuffer() override {
+        if (file != nullptr) {
+            gzclose(file);
+        }
+    }
+
+    // Copying would leave two objects closing the same gzip file
+    GzipStreamBuffer(const GzipStreamBuffer &other) = delete;
+    GzipStreamBuffer &operator=(const GzipStreamBuffer &rhs) = delete;
+
+    /**
+     * Returns whether or not the gzip file was opened successfully.
+     *
+     * @return True if the file is open
+     *         False if the file could not be opened
+     */
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    /**
+     * Returns whether or not reading stopped because the gzip data was
+     * corrupt or truncated, rather than because the end of the file was
+     * reached.
+     *
+     * @return True if the gzip data could not be fully decompressed
+     *         False otherwise
+     */
+    bool hasFailed() const {
+        return failed;
+    }
+
+protected:
+    /**
+     * Refills the buffer with the next block of decompressed bytes.
+     *
+     * @return Next character, or EOF once the file is exhausted (or corrupt)
+     */
+    int_type underflow() override {
+        int bytesRead = gzread(file, buffer.data(), buffer.size());
+        if (bytesRead <= 0) {
+            // A truncated file also ends in a short read, so ask zlib
+            // whether the stream actually finished cleanly
+            int errorCode;
+            gzerror(file, &errorCode);
+            failed = bytesRead < 0 || errorCode != Z_OK;
+            return traits_type::eof();
+        }
+        setg(buffer.data(), buffer.data(), buffer.data() + bytesRead);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    gzFile file; // Handle of the gzip file
+    bool failed; // Whether the gzip data was found to be corrupt
+    vector<char> buffer; // Decompressed bytes not yet read
+};
+#endif
+
 /**
  * Helper method to return a double rounded to three decimal places.
  *
@@ -47,6 +146,9 @@ void testCopy(const WordCounter &wordCounter, const WordCounter &copy,
     if (wordCounter.getLoadFactor() != copy.getLoadFactor())
         cout << type << " failed: mismatching load factor." << endl;
 
+    if (wordCounter.getHotWordHitRate() != copy.getHotWordHitRate())
+        cout << type << " failed: mismatching hot word hit rate." << endl;
+
     for (int i = 0; i < wordsAdded.size(); i++) {
         string checkWord = wordsAdded[i];
         if (wordCounter.getWordCount(checkWord) !=
@@ -59,58 +161,141 @@ void testCopy(const WordCounter &wordCounter, const WordCounter &copy,
 }
 
 /**
- * Trims the line of text of leading spaces. Returns the updated string.
+ * Returns the next word from the given line of text, starting at the given
+ * position and using a space as the delimiter between words. Advances the
+ * position past that word (note that position is passed by reference); the
+ * line itself is left untouched, so only the word is copied.
  *
- * @param line Line of text
- * @return     Updated line of text without leading spaces
+ * @param line     Line of text
+ * @param position Index of the unread remainder of the line; set to the end
+ *                 of the word, or to the end of the line if no word is left
+ * @return         Next word from the line of text, or an empty string if
+ *                 only spaces are left
  */
-string trimLeadingSpaces(string line) {
-    while (line.find(' ') == 0) {
-        line.erase(0, 1);
+string getWordFromLine(const string &line, size_t &position) {
+    const char space = ' '; // Delimiter
+    string word;
+    // Skip leading spaces
+    position = line.find_first_not_of(space, position);
+    if (position == string::npos) {
+        position = line.length();
+    } else {
+        size_t wordEnd = min(line.find(space, position), line.length());
+        word = line.substr(position, wordEnd - position);
+        position = wordEnd;
     }
-    return line;
+    return word;
 }
 
 /**
- * Returns the first word from the given line of text, using a space as the
- * delimiter between words. Removes that word from the line of text (note
- * that line is passed by reference).
- *
- * @param line Line of text
- * @return     First word from the line of text
+ * Tests functionality of the FixedWordCounter class against the WordCounter
+ * class. The common English words (far more than the FixedWordCounter can
+ * hold) are added to both, with words rejected by the full FixedWordCounter
+ * left out of the WordCounter. Then every other common word is removed and
+ * all of them are added again, so the freed Node objects get reused. If any
+ * test fails, an appropriate message will be printed to the console. Nothing
+ * will print to the console if all tests pass.
  */
-string getWordFromLine(string &line) {
-    const char space = ' '; // Delimiter
-    string word;
-    line = trimLeadingSpaces(line);
-    if (!line.empty()) {
-        // Retrieve the first word
-        word = line.substr(0, line.find(space));
-        if (line.find(space) != string::npos) {
-            // Update line to the substring starting from the next space
-            // until the end of the line
-            line = line.substr(line.find(space), line.length());
-        } else {
-            line.erase();
+void testFixedWordCounter() {
+    FixedWordCounter<MAX_FIXED_WORDS> fixedCounter;
+    WordCounter wordCounter;
+    vector<string> words = English::commonWords();
+    int wordCount = words.size();
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < wordCount; i++) {
+            bool isNew = fixedCounter.getWordCount(words[i]) == 0;
+            if (fixedCounter.addWord(words[i]) != 0) {
+                wordCounter.addWord(words[i]);
+            } else if (!isNew || !fixedCounter.full()) {
+                cout << "Fixed word counter failed: rejected \"" << words[i]
+                     << "\" while not full." << endl;
+            }
+        }
+        if (!fixedCounter.full())
+            cout << "Fixed word counter failed: not full after adding "
+                 << "common words." << endl;
+
+        // Free up Node objects for the next pass to reuse
+        if (pass == 0) {
+            for (int i = 0; i < wordCount; i += 2) {
+                fixedCounter.removeWord(words[i]);
+                wordCounter.removeWord(words[i]);
+            }
+        }
+    }
+
+    if (fixedCounter.getUniqueWordCount() != wordCounter.getUniqueWordCount())
+        cout << "Fixed word counter failed: mismatching unique word count."
+             << endl;
+
+    if (fixedCounter.getTotalWordCount() != wordCounter.getTotalWordCount())
+        cout << "Fixed word counter failed: mismatching total word count."
+             << endl;
+
+    for (int i = 0; i < wordCount; i++) {
+        if (fixedCounter.getWordCount(words[i]) !=
+            wordCounter.getWordCount(words[i])) {
+            cout << "Fixed word counter failed: mismatching word count for \""
+                 << words[i] << "\"." << endl;
         }
     }
-    return word;
 }
 
 /**
  * Displays counts of each word in the given WordCounter object, from the given
- * set of words to analyze.
+ * set of words to analyze. A word ending in an asterisk (e.g. "hob*") is
+ * treated as a prefix, and the most frequent words starting with that prefix
+ * are displayed along with their counts. Words that aren't found are shown
+ * with suggestions of similar words that were.
  *
  * @param wordsToAnalyze Line of words to analyze
  * @param wordCounter    WordCounter object
+ * @param stemming       Whether wordCounter holds stems, in which case each
+ *                       word is stemmed before it is looked up and before
+ *                       similar words are suggested. Prefixes are matched
+ *                       against the stems as typed, since stemming a partial
+ *                       word isn't meaningful.
  */
-void displayWordCounts(string wordsToAnalyze, WordCounter &wordCounter) {
+void displayWordCounts(string wordsToAnalyze,
+                       const WordCounter &wordCounter, bool stemming) {
+    const char wildcard = '*'; // Marks a prefix query
     string word;
+    size_t position = 0; // Index of the next word in wordsToAnalyze
     cout << "Analysis of words:" << endl;
-    while (wordsToAnalyze.length() != 0) {
-        word = getWordFromLine(wordsToAnalyze);
-        cout << "        " <<  word << ": " << wordCounter.getWordCount(word)
-             << endl;
+    while (position < wordsToAnalyze.length()) {
+        word = getWordFromLine(wordsToAnalyze, position);
+        if (!word.empty() && word.back() == wildcard) {
+            string prefix = word.substr(0, word.length() - 1);
+            cout << "        " << word << ":";
+            vector<pair<string, int>> matches =
+                    wordCounter.getWordsWithPrefix(prefix, MAX_PREFIX_MATCHES);
+            for (const pair<string, int> &match : matches) {
+                cout << " " << match.first << " (" << match.second << ")";
+            }
+            cout << endl;
+        } else {
+            // Word as it is stored in wordCounter
+            string key = stemming ? English::stem(word) : word;
+            int wordCount = wordCounter.getWordCount(key);
+            cout << "        " << word << ": " << wordCount;
+            // Suggest close matches for words that weren't found, since the
+            // word may be misspelled
+            vector<string> similarWords;
+            if (wordCount == 0) {
+                similarWords = wordCounter.getSimilarWords(key);
+            }
+            int suggestionCount = min((int) similarWords.size(),
+                                      MAX_SUGGESTIONS);
+            for (int i = 0; i < suggestionCount; i++) {
+                cout << (i == 0 ? " (did you mean: " : ", ")
+                     << similarWords[i];
+            }
+            if (suggestionCount > 0) {
+                cout << "?)";
+            }
+            cout << endl;
+        }
     }
 }
 
@@ -128,43 +313,171 @@ void removeCommonWords(WordCounter &wordCounter) {
 }
 
 /**
- * Displays given WordCounter object's unique and total word counts, and load
- * factor.
+ * Returns a WordCounter object holding the stems (via English::stem) of the
+ * words in the given WordCounter object, where the count of each stem is the
+ * total count of the words sharing that stem. Each distinct word is stemmed
+ * once, no matter how many times it was added.
  *
  * @param wordCounter WordCounter object
+ * @return            WordCounter object of stems
+ */
+WordCounter stemWords(const WordCounter &wordCounter) {
+    WordCounter stemCounter;
+    wordCounter.forEachWord([&stemCounter](const string &word, int count) {
+        stemCounter.addWord(English::stem(word), count);
+    });
+    return stemCounter;
+}
+
+/**
+ * Displays given WordCounter object's unique and total word counts, load
+ * factor, and longest chain length, along with the given hot word cache hit
+ * rate.
+ *
+ * @param wordCounter    WordCounter object
+ * @param hotWordHitRate Hot word cache hit rate while the words were read
  */
-void displayStatistics(const WordCounter &wordCounter) {
+void displayStatistics(const WordCounter &wordCounter, double hotWordHitRate) {
     cout << "\nWord counter statistics:" << endl;
     cout << "        Capacity: " << wordCounter.getCapacity() << endl;
     cout << "        Unique  : " << wordCounter.getUniqueWordCount() << endl;
     cout << "        Total   : " << wordCounter.getTotalWordCount() << endl;
     cout << "        Load    : " << roundToThree(wordCounter.getLoadFactor())
          << endl;
+    cout << "        Chain   : " << wordCounter.getLongestChainLength()
+         << endl;
+    cout << "        Hot hits: " << roundToThree(hotWordHitRate) << endl;
 }
 
 /**
- * Appends the first word from the next line of the input file, to the word
+ * Appends the first word from the next line of the input stream, to the word
  * argument, then returns the updated word.
  *
- * @param word      Word to append to
- * @param line      Line of text (passed by reference so calling method can
- *                  get the new line of text)
- * @param inputFile Input file of text
- * @return          Original word plus with the next word appended to it
+ * @param word     Word to append to
+ * @param line     Line of text (passed by reference so calling method can
+ *                 get the new line of text)
+ * @param position Index of the unread remainder of line (passed by
+ *                 reference, like line)
+ * @param input    Input stream of text
+ * @return         Original word plus with the next word appended to it
  */
-string appendNextWord(string word, string &line, ifstream &inputFile) {
+string appendNextWord(string word, string &line, size_t &position,
+                      istream &input) {
     word.erase(word.length() - 1, 1);
     // This updates line so that loop can continue
-    getline(inputFile, line);
+    getline(input, line);
+    position = 0;
     // Append first word from the line
-    string toAppend = getWordFromLine(line);
+    string toAppend = getWordFromLine(line, position);
     word.append(toAppend);
     return word;
 }
 
+/**
+ * Reads the next word from the input stream, cleaned via the English class.
+ * Words are taken from the unread remainder of the current line, and lines
+ * are pulled from the stream only as they are needed. A word ending in a
+ * hyphen at the end of a line is joined with the first word of the next line.
+ * Works on any input stream (file, standard input or string stream).
+ *
+ * @param input    Input stream of text
+ * @param line     Current line (passed by reference so it carries over
+ *                 between calls; should start out empty)
+ * @param position Index of the unread remainder of line (passed by
+ *                 reference, like line; should start out 0)
+ * @param word     Set to the next word
+ * @return         True if a word was read
+ *                 False if the stream has no words left
+ */
+bool readWord(istream &input, string &line, size_t &position, string &word) {
+    while (true) {
+        while (position < line.length()) {
+            word = getWordFromLine(line, position);
+            word = English::cleanWord(word);
+            // Skip over anything that cleans to an empty string
+            if (word.empty()) {
+                continue;
+            }
+            // If the word ends in a hyphen
+            if (word.find('-') == word.length() - 1) {
+                // If nothing is left of the line, we've processed the
+                // entire line meaning the first word from the next line
+                // needs to be appended
+                if (position == line.length()) {
+                    word = appendNextWord(word, line, position, input);
+                    // If line isn't empty yet, the hyphen can be removed
+                } else {
+                    word.erase(word.length() - 1, 1);
+                }
+
+                word = English::cleanWord(word);
+            }
+            return true;
+        }
+        // Retrieve the next line once the current one is used up
+        if (!getline(input, line)) {
+            return false;
+        }
+        position = 0;
+    }
+}
+
+/**
+ * Reads words from an input stream and adds each word to the WordCounter
+ * object. Each word is cleaned via the English class, prior to being added to
+ * WordCounter.
+ *
+ * @param input       Input stream of text
+ * @param wordCounter WordCounter object
+ * @param wordsAdded  Vector of words added to WordCounter object
+ */
+void addWordsFromStream(istream &input, WordCounter &wordCounter,
+                        vector<string> &wordsAdded) {
+    string line; // Holds the current line from the stream
+    size_t position = 0; // Index of the unread part of line
+    string word;
+    while (readWord(input, line, position, word)) {
+        int oldUnique = wordCounter.getUniqueWordCount();
+        // Add word to WordCounter and word tracking vector
+        wordCounter.addWord(word);
+        if (wordCounter.getUniqueWordCount() > oldUnique) {
+            wordsAdded.push_back(word);
+        }
+    }
+}
+
+/**
+ * Returns whether or not the given file name has the gzip file extension.
+ *
+ * @param fileName Name of the file
+ * @return         True if the file name ends in ".gz"
+ *                 False otherwise
+ */
+bool isGzipFile(const string &fileName) {
+    return fileName.length() >= GZIP_EXTENSION.length() &&
+           fileName.compare(fileName.length() - GZIP_EXTENSION.length(),
+                            GZIP_EXTENSION.length(), GZIP_EXTENSION) == 0;
+}
+
+/**
+ * Prints an error about the given file to the console. Files may be read on
+ * several threads at once, so the output is locked to keep each message on
+ * its own line.
+ *
+ * @param fileName Name of the file
+ * @param problem  What went wrong, completing "Error: file <name> ..."
+ */
+void printFileError(const string &fileName, const string &problem) {
+    static mutex outputMutex; // Guards cout across file-reading threads
+    lock_guard<mutex> lock(outputMutex);
+    cout << "Error: file \"" << fileName << "\" " << problem << "." << endl;
+}
+
 /**
  * Reads words from a file and adds each word to the WordCounter object. Each
  * word is cleaned via the English class, prior to being added to WordCounter.
+ * Files ending in ".gz" are decompressed as they are read, if the program
+ * was built with zlib.
  *
  * @param fileName    Name of the file
  * @param wordCounter WordCounter object
@@ -172,46 +485,84 @@ string appendNextWord(string word, string &line, ifstream &inputFile) {
  */
 void addWordsFromFile(const string &fileName, WordCounter &wordCounter,
                       vector<string> &wordsAdded) {
-    ifstream inputFile(fileName);
-    if (inputFile) {
-        string line; // Holds line of text from file
-        // Retrieves each line from the file
-        while (getline(inputFile, line)) {
-            string word;
-            while (line.length() != 0) {
-                word = getWordFromLine(line);
-                word = English::cleanWord(word);
-                // If word is not an empty string
-                if (!word.empty()) {
-                    // If the word ends in a hyphen
-                    if (word.find('-') == word.length() - 1) {
-                        // If line is empty, we've processed the entire line
-                        // meaning the first word from the next line needs to
-                        // be appended
-                        if (line.empty()) {
-                            word = appendNextWord(word, line, inputFile);
-                            // If line isn't empty yet, the hyphen can be removed
-                        } else {
-                            word.erase(word.length() - 1, 1);
-                        }
-
-                        word = English::cleanWord(word);
-                    }
-                    int oldUnique = wordCounter.getUniqueWordCount();
-                    // Add word to WordCounter and word tracking vector
-                    wordCounter.addWord(word);
-                    if (wordCounter.getUniqueWordCount() > oldUnique) {
-                        wordsAdded.push_back(word);
-                    }
-                }
+    if (isGzipFile(fileName)) {
+#ifdef HAVE_ZLIB
+        GzipStreamBuffer gzipBuffer(fileName);
+        if (gzipBuffer.isOpen()) {
+            istream input(&gzipBuffer);
+            addWordsFromStream(input, wordCounter, wordsAdded);
+            if (gzipBuffer.hasFailed()) {
+                printFileError(fileName, "is corrupt or truncated");
             }
+        } else {
+            printFileError(fileName, "could not be read");
         }
+#else
+        printFileError(fileName, "is gzip, which this build does not support");
+#endif
+        return;
+    }
+
+    // Give the stream a large buffer (before opening the file) so the file
+    // is read in a few large blocks rather than many small ones
+    vector<char> readBuffer(READ_BUFFER_SIZE);
+    ifstream inputFile;
+    inputFile.rdbuf()->pubsetbuf(readBuffer.data(), readBuffer.size());
+    inputFile.open(fileName);
+    if (inputFile) {
+        addWordsFromStream(inputFile, wordCounter, wordsAdded);
     } else {
-        cout << "Error: unable to read file." << endl;
+        printFileError(fileName, "could not be read");
     }
     inputFile.close();
 }
 
+/**
+ * Reads words from each of the given files and adds them to the WordCounter
+ * object. Files are spread across worker threads, each of which counts into
+ * its own WordCounter; idle workers claim the next unread file, so one large
+ * file doesn't hold up the rest. Each worker's counts are added to
+ * wordCounter once it runs out of files.
+ *
+ * @param fileNames   Names of the files
+ * @param wordCounter WordCounter object
+ * @param wordsAdded  Vector of words added to WordCounter object
+ */
+void addWordsFromFiles(const vector<string> &fileNames,
+                       WordCounter &wordCounter, vector<string> &wordsAdded) {
+    int fileCount = fileNames.size();
+    int threadCount = min(fileCount, (int) thread::hardware_concurrency());
+    // No need for worker threads with a single file
+    if (threadCount <= 1) {
+        for (const string &fileName : fileNames) {
+            addWordsFromFile(fileName, wordCounter, wordsAdded);
+        }
+        return;
+    }
+
+    atomic<int> nextFile(0); // Index of the next file to be claimed
+    mutex resultMutex; // Guards wordCounter and wordsAdded
+    auto countFiles = [&]() {
+        WordCounter localCounter;
+        vector<string> localWordsAdded;
+        for (int file = nextFile++; file < fileCount; file = nextFile++) {
+            addWordsFromFile(fileNames[file], localCounter, localWordsAdded);
+        }
+        lock_guard<mutex> lock(resultMutex);
+        wordCounter.addWords(localCounter);
+        wordsAdded.insert(wordsAdded.end(), localWordsAdded.begin(),
+                          localWordsAdded.end());
+    };
+
+    vector<thread> workers;
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(countFiles);
+    }
+    for (thread &worker : workers) {
+        worker.join();
+    }
+}
+
 /**
  * Returns a set of words to analyze from the user.
  *
@@ -239,46 +590,105 @@ int getCapacity() {
 }
 
 /**
- * Returns file name retrieved from the user.
+ * Returns the next file name from the given line of text, starting at the
+ * given position. File names are separated by spaces, so a name containing
+ * spaces must be enclosed in double quotes. Advances the position past that
+ * file name (note that position is passed by reference).
+ *
+ * @param line     Line of file names
+ * @param position Index of the unread remainder of the line
+ * @return         Next file name, or an empty string if none is left
+ */
+string getFileNameFromLine(const string &line, size_t &position) {
+    const char quote = '"';
+    position = min(line.find_first_not_of(' ', position), line.length());
+    if (position == line.length() || line[position] != quote) {
+        return getWordFromLine(line, position);
+    }
+    // Take everything up to the closing quote (or the end of the line)
+    size_t nameStart = position + 1;
+    size_t nameEnd = min(line.find(quote, nameStart), line.length());
+    position = min(nameEnd + 1, line.length());
+    return line.substr(nameStart, nameEnd - nameStart);
+}
+
+/**
+ * Returns file names retrieved from the user, separated by spaces. Names
+ * containing spaces must be enclosed in double quotes.
  *
- * @return File name
+ * @return File names
  */
-string getFileName() {
-    string fileName;
-    cout << "What is the filename? ";
-    getline(cin, fileName);
-    return fileName;
+vector<string> getFileNames() {
+    string line;
+    vector<string> fileNames;
+    cout << "What are the filenames (separated by a space; quote names with "
+         << "spaces)? ";
+    getline(cin, line);
+    size_t position = 0; // Index of the next file name in line
+    while (position < line.length()) {
+        string fileName = getFileNameFromLine(line, position);
+        if (!fileName.empty()) {
+            fileNames.push_back(fileName);
+        }
+    }
+    return fileNames;
 }
 
 /**
  * Tests functionality of the WordCounter class. Words are added from the
- * user-provided file to the WordCounter and the user provides words to
+ * user-provided files to the WordCounter and the user provides words to
  * analyze against the what is stored in the WordCounter object. Various
- * methods are tested as well.
+ * methods are tested as well. Passing the --stem option counts words by
+ * their stems, so that e.g. "run", "runs" and "running" are counted together.
  *
- * @return EXIT_SUCCESS Indicates successful program
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @return     EXIT_SUCCESS Indicates successful program
  */
-int main() {
+int main(int argc, char *argv[]) {
     vector<string> wordsAdded; // To keep track of words (for testing purposes)
+    bool stemming = argc > 1 && argv[1] == STEM_OPTION;
 
-    // Retrieve file name from user
-    string fileName = getFileName();
+    // Retrieve file names from user
+    vector<string> fileNames = getFileNames();
     WordCounter wordCounter;
 
-    // Read through file and update word counter
-    addWordsFromFile(fileName, wordCounter, wordsAdded);
+    // Read through files and update word counter
+    addWordsFromFiles(fileNames, wordCounter, wordsAdded);
     removeCommonWords(wordCounter);
-    displayStatistics(wordCounter);
+    // Taken before stemming, which rebuilds the table (and its cache) from
+    // the distinct words rather than from the text
+    double hotWordHitRate = wordCounter.getHotWordHitRate();
+    if (stemming) {
+        wordCounter = stemWords(wordCounter);
+    }
+    displayStatistics(wordCounter, hotWordHitRate);
+    // The table is done changing, so prefix queries can use a sorted index
+    wordCounter.buildPrefixIndex();
 
     // Retrieve set of words to analyze from the user
     string wordsToAnalyze = getWordsToAnalyze();
-    displayWordCounts(wordsToAnalyze, wordCounter);
+    displayWordCounts(wordsToAnalyze, wordCounter, stemming);
 
     // Nothing should print to console if implemented correctly
     WordCounter copyConstructor(wordCounter);
     testCopy(wordCounter, copyConstructor, wordsAdded, "Copy constructor");
     WordCounter assignOperator = wordCounter;
     testCopy(wordCounter, assignOperator, wordsAdded, "Assignment operator");
+    stringstream snapshot;
+    wordCounter.save(snapshot);
+    WordCounter loaded;
+    if (!loaded.load(snapshot))
+        cout << "Save and load failed: malformed snapshot." << endl;
+    testCopy(wordCounter, loaded, wordsAdded, "Save and load");
+    // Malformed snapshots must be rejected without touching the table: an
+    // out-of-range capacity, and a word length far beyond the stream's end
+    stringstream hugeCapacity("2000000000 0 0\n");
+    stringstream hugeLength("11 0 0\n1000000000 a 1\n");
+    if (loaded.load(hugeCapacity) || loaded.load(hugeLength))
+        cout << "Save and load failed: accepted malformed snapshot." << endl;
+    testCopy(wordCounter, loaded, wordsAdded, "Malformed load");
+    testFixedWordCounter();
 
     return EXIT_SUCCESS;
 }